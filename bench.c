@@ -0,0 +1,358 @@
+/*******************************************************************************
+* Date:   10-19-2026
+* Desc:   This is the benchmark program for smallsh. It links smallShell.o to
+*         time the parser directly and drives the smallsh binary over pipes to
+*         time spawning, background fan-out, redirection, and here-documents
+*         against the temp files they replace. Results are printed to stdout
+*         as JSON with percentiles so runs can be compared across releases and
+*         build configurations.
+*
+*         usage: smallshBench [path to smallsh]
+*******************************************************************************/
+#include "shellDriver.h"
+
+// compiler flags the benchmark was built with (set by the makefile):
+#ifndef BENCH_CFLAGS
+#define BENCH_CFLAGS "unknown"
+#endif
+
+// representative input line for the parser benchmark:
+#define PARSE_LINE "ls -la /tmp/dir.$$ arg1 arg2 $$ < in.txt > out.$$ &\n"
+#define PARSE_SAMPLES 50        // timed batches of parsed lines
+#define PARSE_BATCH 20000       // lines parsed per batch
+
+#define SPAWN_WARMUP 50         // untimed commands before latency samples
+#define SPAWN_SAMPLES 1000      // timed foreground commands
+
+#define FANOUT_SAMPLES 10       // shells started for the fan-out benchmark
+#define FANOUT_JOBS 500         // background jobs launched by each shell
+
+#define STDIN_SAMPLES 500       // timed commands for each stdin benchmark
+#define HEREDOC_LINES 256       // 64 byte lines, large enough to use memfd
+
+/*******************************************************************************
+* Function: nowNs
+* Desc:     returns the monotonic clock in nanoseconds.
+*******************************************************************************/
+double nowNs(){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*******************************************************************************
+* Function: compareDoubles
+* Desc:     qsort comparison function for ascending doubles.
+*******************************************************************************/
+int compareDoubles(const void* a, const void* b){
+
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+/*******************************************************************************
+* Function: percentile
+* Desc:     receives a sorted array of samples and returns the nearest-rank
+*           value for the percentile p (0-100).
+*******************************************************************************/
+double percentile(double* sorted, int count, double p){
+
+    int rank = (int)(p / 100.0 * count + 0.5);
+
+    if(rank < 1)
+        rank = 1;
+    if(rank > count)
+        rank = count;
+
+    return sorted[rank - 1];
+}
+
+/*******************************************************************************
+* Function: printResult
+* Desc:     sorts the samples and prints one JSON result object with its unit,
+*           sample count, min, mean, percentiles, and max. last is false when
+*           another result follows so a comma is printed.
+*******************************************************************************/
+void printResult(char* name, char* unit, double* samples, int count,
+                 bool last){
+
+    double sum = 0;
+
+    qsort(samples, count, sizeof(double), compareDoubles);
+
+    for(int i = 0; i < count; ++i)
+        sum += samples[i];
+
+    printf("    \"%s\": {\"unit\": \"%s\", \"samples\": %d, \"min\": %.3f, "
+           "\"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, "
+           "\"max\": %.3f}%s\n", name, unit, count, samples[0], sum / count,
+           percentile(samples, count, 50), percentile(samples, count, 90),
+           percentile(samples, count, 99), samples[count - 1],
+           last ? "" : ",");
+}
+
+/*******************************************************************************
+* Function: sendLine
+* Desc:     writes a whole command line to the shell's stdin.
+*******************************************************************************/
+void sendLine(struct shell* sh, char* line){
+
+    size_t len = strlen(line);
+    ssize_t written;
+
+    while(len > 0){
+        written = write(sh->toShell, line, len);
+        if(written == -1){
+            perror("write()");
+            exit(1);
+        }
+        line += written;
+        len -= written;
+    }
+}
+
+/*******************************************************************************
+* Function: waitForPrompt
+* Desc:     reads the shell's output until it ends with the ": " prompt, which
+*           smallsh prints (and flushes) just before blocking for input. only
+*           used with commands that print nothing themselves.
+*******************************************************************************/
+void waitForPrompt(struct shell* sh){
+
+    char buffer[4096];
+    char prev = '\0';
+    ssize_t got;
+
+    while((got = read(sh->fromShell, buffer, sizeof(buffer))) > 0){
+        if(got >= 2 && buffer[got - 2] == ':' && buffer[got - 1] == ' ')
+            return;
+        if(got == 1 && prev == ':' && buffer[0] == ' ')
+            return;
+        prev = buffer[got - 1];
+    }
+
+    fprintf(stderr, "smallsh exited while waiting for prompt\n");
+    exit(1);
+}
+
+/*******************************************************************************
+* Function: stopShell
+* Desc:     sends exit, drains remaining output until the shell closes stdout,
+*           and reaps it.
+*******************************************************************************/
+void stopShell(struct shell* sh){
+
+    char buffer[4096];
+
+    sendLine(sh, "exit\n");
+    close(sh->toShell);
+
+    while(read(sh->fromShell, buffer, sizeof(buffer)) > 0)
+        ;
+
+    close(sh->fromShell);
+    waitpid(sh->pid, NULL, 0);
+}
+
+/*******************************************************************************
+* Function: benchParse
+* Desc:     times expandAny$$ and parseString (plus freeCommandList) on
+*           PARSE_LINE. each sample is the mean ns per line over PARSE_BATCH
+*           lines.
+*******************************************************************************/
+void benchParse(double* samples){
+
+    double start;
+    char* input;
+    struct command* newCommand;
+
+    for(int s = 0; s < PARSE_SAMPLES; ++s){
+        start = nowNs();
+
+        for(int i = 0; i < PARSE_BATCH; ++i){
+            // mirror prompt: expandAny$$ frees the buffer it receives:
+            input = trackedMalloc(sizeof(PARSE_LINE));
+            memcpy(input, PARSE_LINE, sizeof(PARSE_LINE));
+            input = expandAny$$(input);
+            removeNewLine(input);
+
+            newCommand = trackedMalloc(sizeof(struct command));
+            parseString(input, " ", newCommand);
+            trackedFree(input);
+            freeCommandList(newCommand);
+        }
+
+        samples[s] = (nowNs() - start) / PARSE_BATCH;
+    }
+}
+
+/*******************************************************************************
+* Function: benchSpawn
+* Desc:     times foreground commands through a running smallsh, from writing
+*           the line until the next prompt. each sample is one command, in
+*           microseconds, so it covers parse, fork, exec, and reap.
+*******************************************************************************/
+void benchSpawn(char* path, char* line, double* samples){
+
+    double start;
+    struct shell sh = startShell(path, false);
+
+    waitForPrompt(&sh);
+
+    for(int i = 0; i < SPAWN_WARMUP; ++i){
+        sendLine(&sh, line);
+        waitForPrompt(&sh);
+    }
+
+    for(int i = 0; i < SPAWN_SAMPLES; ++i){
+        start = nowNs();
+        sendLine(&sh, line);
+        waitForPrompt(&sh);
+        samples[i] = (nowNs() - start) / 1e3;
+    }
+
+    stopShell(&sh);
+}
+
+/*******************************************************************************
+* Function: benchFanout
+* Desc:     for each sample starts a fresh smallsh, launches FANOUT_JOBS
+*           background jobs, and exits (which reaps them all). each sample is
+*           the resulting background launches per second.
+*******************************************************************************/
+void benchFanout(char* path, double* samples){
+
+    double start;
+    struct shell sh;
+
+    for(int s = 0; s < FANOUT_SAMPLES; ++s){
+        sh = startShell(path, false);
+        waitForPrompt(&sh);
+
+        start = nowNs();
+        for(int i = 0; i < FANOUT_JOBS; ++i)
+            sendLine(&sh, "true &\n");
+        stopShell(&sh);
+
+        samples[s] = FANOUT_JOBS / ((nowNs() - start) / 1e9);
+    }
+}
+
+/*******************************************************************************
+* Function: benchStdin
+* Desc:     times feeding body to cat's stdin through a running smallsh. with
+*           useTempFile the harness writes body to a temp file, runs
+*           "cat < file", and removes the file, as users did before here-docs.
+*           otherwise the body is sent inline: as a here-string if it is one
+*           line, else as a here-document. each sample is one command, in
+*           microseconds.
+*******************************************************************************/
+void benchStdin(char* path, char* body, bool useTempFile, double* samples){
+
+    double start;
+    int fd;
+    char tempName[] = "/tmp/smallshBench-XXXXXX";
+    char* line = malloc(strlen(body) + 128);
+    struct shell sh = startShell(path, false);
+
+    // a single line (without its newline) fits in a here-string:
+    if(strchr(body, '\n') == body + strlen(body) - 1)
+        sprintf(line, "cat > /dev/null <<< %.*s\n", (int)strlen(body) - 1,
+                body);
+    else
+        sprintf(line, "cat > /dev/null << EOF\n%sEOF\n", body);
+
+    waitForPrompt(&sh);
+
+    for(int i = 0; i < SPAWN_WARMUP + STDIN_SAMPLES; ++i){
+        start = nowNs();
+
+        if(useTempFile){
+            fd = mkstemp(tempName);
+            if(fd == -1 || write(fd, body, strlen(body)) == -1){
+                perror("temp file");
+                exit(1);
+            }
+            close(fd);
+            sprintf(line, "cat > /dev/null < %s\n", tempName);
+        }
+
+        sendLine(&sh, line);
+        waitForPrompt(&sh);
+
+        if(useTempFile){
+            unlink(tempName);
+            strcpy(tempName, "/tmp/smallshBench-XXXXXX");
+        }
+
+        if(i >= SPAWN_WARMUP)
+            samples[i - SPAWN_WARMUP] = (nowNs() - start) / 1e3;
+    }
+
+    stopShell(&sh);
+    free(line);
+}
+
+int main(int argc, char* argv[]){
+
+    char* path = argc > 1 ? argv[1] : "./smallsh";
+
+    double parseSamples[PARSE_SAMPLES];
+    double parseRates[PARSE_SAMPLES];
+    double spawnSamples[SPAWN_SAMPLES];
+    double redirSamples[SPAWN_SAMPLES];
+    double fanoutSamples[FANOUT_SAMPLES];
+    double stdinSamples[4][STDIN_SAMPLES];
+
+    // here-document body: HEREDOC_LINES lines of 63 x's:
+    char* body = malloc(HEREDOC_LINES * 64 + 1);
+    for(int i = 0; i < HEREDOC_LINES; ++i){
+        memset(body + i * 64, 'x', 63);
+        body[i * 64 + 63] = '\n';
+    }
+    body[HEREDOC_LINES * 64] = '\0';
+
+    // background jobs write to /dev/null, but keep a closed pipe from
+    // killing the harness if the shell dies early:
+    signal(SIGPIPE, SIG_IGN);
+
+    benchParse(parseSamples);
+    for(int i = 0; i < PARSE_SAMPLES; ++i)
+        parseRates[i] = 1e9 / parseSamples[i];
+
+    benchSpawn(path, "true\n", spawnSamples);
+    benchSpawn(path, "true < /dev/null > /dev/null\n", redirSamples);
+    benchFanout(path, fanoutSamples);
+    benchStdin(path, body, false, stdinSamples[0]);
+    benchStdin(path, body, true, stdinSamples[1]);
+    benchStdin(path, "hello\n", false, stdinSamples[2]);
+    benchStdin(path, "hello\n", true, stdinSamples[3]);
+    free(body);
+
+    printf("{\n");
+    printf("  \"shell\": \"%s\",\n", path);
+    printf("  \"cflags\": \"%s\",\n", BENCH_CFLAGS);
+    printf("  \"results\": {\n");
+    printResult("parse_ns_per_line", "ns", parseSamples, PARSE_SAMPLES, false);
+    printResult("parse_lines_per_sec", "lines/s", parseRates, PARSE_SAMPLES,
+                false);
+    printResult("foreground_spawn_reap", "us", spawnSamples, SPAWN_SAMPLES,
+                false);
+    printResult("foreground_redirect", "us", redirSamples, SPAWN_SAMPLES,
+                false);
+    printResult("background_fanout", "jobs/s", fanoutSamples, FANOUT_SAMPLES,
+                false);
+    printResult("heredoc_16k", "us", stdinSamples[0], STDIN_SAMPLES, false);
+    printResult("tempfile_16k", "us", stdinSamples[1], STDIN_SAMPLES, false);
+    printResult("herestring_line", "us", stdinSamples[2], STDIN_SAMPLES,
+                false);
+    printResult("tempfile_line", "us", stdinSamples[3], STDIN_SAMPLES, true);
+    printf("  }\n");
+    printf("}\n");
+
+    return EXIT_SUCCESS;
+}
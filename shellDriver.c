@@ -0,0 +1,55 @@
+/*******************************************************************************
+* Date:   10-19-2026
+* Desc:   This is the implementation file for the smallsh driver shared by the
+*         benchmark and soak test programs.
+*******************************************************************************/
+#include "shellDriver.h"
+
+/*******************************************************************************
+* Function: startShell
+* Desc:     starts the smallsh binary at path with its stdin and stdout
+*           connected to pipes held in the returned shell struct. stderr is
+*           left alone so errors stay visible. if nonBlocking is true the write
+*           end is non-blocking so output can be drained while input is
+*           pending.
+*******************************************************************************/
+struct shell startShell(char* path, bool nonBlocking){
+
+    struct shell sh;
+    int inPipe[2];
+    int outPipe[2];
+
+    if(pipe(inPipe) == -1 || pipe(outPipe) == -1){
+        perror("pipe()");
+        exit(1);
+    }
+
+    sh.pid = fork();
+
+    if(sh.pid == -1){
+        perror("fork()");
+        exit(1);
+    }
+
+    if(sh.pid == 0){
+        dup2(inPipe[0], STDIN_FILENO);
+        dup2(outPipe[1], STDOUT_FILENO);
+        close(inPipe[0]);
+        close(inPipe[1]);
+        close(outPipe[0]);
+        close(outPipe[1]);
+        execl(path, path, NULL);
+        perror(path);
+        exit(1);
+    }
+
+    close(inPipe[0]);
+    close(outPipe[1]);
+    sh.toShell = inPipe[1];
+    sh.fromShell = outPipe[0];
+
+    if(nonBlocking)
+        fcntl(sh.toShell, F_SETFL, O_NONBLOCK);
+
+    return sh;
+}
@@ -0,0 +1,21 @@
+/*******************************************************************************
+* Date:   10-19-2026
+* Desc:   This is the specification file for the smallsh driver shared by the
+*         benchmark and soak test programs. It starts the smallsh binary with
+*         its stdin and stdout connected to pipes.
+*******************************************************************************/
+#include "smallShell.h"
+
+#ifndef SHELL_DRIVER_H
+#define SHELL_DRIVER_H
+
+struct shell {
+    pid_t pid;
+    int toShell;     // write end of smallsh's stdin
+    int fromShell;   // read end of smallsh's stdout
+};
+
+// starts smallsh at path, optionally with a non-blocking write end:
+struct shell startShell(char*, bool);
+
+#endif
@@ -9,72 +9,127 @@
 // global variable used to entering/exiting foreground-only mode:
 bool foregroundMode = false;
 
+// whether stdin is a terminal, and the process group owning it at startup:
+bool interactive = false;
+pid_t shellPgid = 0;
+
+// global counters kept by trackedMalloc/trackedFree, reported by memstats:
+struct memStats heapStats = {0, 0, 0};
+
 /*******************************************************************************
 * Function: runShell
 * Desc:     function loops small shell and reacts to user's input. it receives
 *           the status of processes run for notification to the user. commands
 *           cd, status, and exit are built-in commands and programmed within
-*           this file. remaining commands use exec() functions.
+*           this file. remaining commands use exec() functions. a line may hold
+*           several commands joined by ;, && or || which run in order.
 *******************************************************************************/
 void runShell(){
 
     // ignore SIGINT:
     ignoreSIGINT();
+    // take terminal ownership for handing it to foreground jobs:
+    initJobControl();
     // holds status of last foreground process:
     int wstatus = 0; 
 
-    // holds all of the child processes running in the background:
-    int* childProcessArray = (int*)malloc(100 * sizeof(int)); 
-    // initialize child process array elements to 0:
-    initProcArray(childProcessArray);
+    // holds all of the background and stopped jobs:
+    struct jobTable* jobTable = trackedMalloc(sizeof(struct jobTable));
+    // start with an empty job table:
+    initJobTable(jobTable);
     
-    // command struct holds first arg as pathname and remaining as args array:
+    // command struct holds first arg as pathname and remaining as args array,
+    // linked to the commands after it on the same line:
+    struct command* commandList = NULL;
     struct command* newCommand = NULL;
 
     // categorizes user's input for switch:
-    enum cmd{exit, cd, status, other, empty};
+    enum cmd{exit, cd, status, other, empty, memstats, jobs, fg, bg,
+              batch};
     enum cmd input = other;                             // holds user's input
 
     while(input != exit){
         // parent catches SIGTSTP and run only foreground:
         installSIGTSTP();
 
-        newCommand = prompt();
-        // assign input based on user's prompt entry:
-        input = checkCommand(newCommand->pathname);
+        // whole line is expanded and parsed once into a list of commands:
+        commandList = prompt();
+
+        for(newCommand = commandList; newCommand != NULL && input != exit;
+            newCommand = newCommand->next){
+
+            // && and || skip the command based on the last status:
+            if(!shouldRunCommand(newCommand, wstatus))
+                continue;
+
+            // assign input based on user's prompt entry:
+            input = checkCommand(newCommand->pathname);
+
+            switch(input){
+                // built-in function:
+                case exit:
+                    // kill any remaining child processes running:
+                    killChildProcesses(jobTable);
+                    break;
+                // built-in function:
+                case cd:
+                    wstatus = runCd(newCommand);
+                    break;
+                // built-in function:
+                case status:
+                    wstatus = runStatus(wstatus);
+                    break;
+                // built-in function:
+                case memstats:
+                    wstatus = runMemStats();
+                    break;
+                // built-in function:
+                case jobs:
+                    wstatus = runJobs(jobTable);
+                    break;
+                // built-in function:
+                case fg:
+                    wstatus = runFg(newCommand, jobTable);
+                    if(wstatus == 2){
+                        printf("terminated by signal 2\n");
+                        fflush(stdout);
+                    }
+                    break;
+                // built-in function:
+                case bg:
+                    wstatus = runBg(newCommand, jobTable);
+                    break;
+                // built-in function:
+                case batch:
+                    wstatus = runBatch(newCommand);
+                    if(wstatus == 2){
+                        printf("terminated by signal 2\n");
+                        fflush(stdout);
+                    }
+                    break;
+                // nonbuilt-in function:
+                case other:
+                    wstatus = runOther(newCommand, jobTable);
+                    if(wstatus == 2){
+                        printf("terminated by signal 2\n");
+                        fflush(stdout);
+                    }
+                    break;
+                default:
+                    break;
+            }
 
-        switch(input){
-            // built-in function:
-            case exit:
-                // kill any remaining child processes running:
-                killChildProcesses(childProcessArray);
-                break;
-            // built-in function:
-            case cd:
-                wstatus = runCd(newCommand);
-                break;
-            // built-in function:
-            case status:
-                wstatus = runStatus(wstatus);
-                break;
-            // nonbuilt-in function:
-            case other:
-                wstatus = runOther(newCommand, childProcessArray);
-                if(wstatus == 2){
-                    printf("terminated by signal 2\n");
-                    fflush(stdout);
-                }
-                break;
-            default:
+            // ^C abandons the rest of the list:
+            if(wstatus == 2)
                 break;
         }
 
-        // check if child processes have concluded/terminated:
+        // check if child processes have concluded/terminated, once per list:
         if(input != exit)
-            checkChildProcesses(childProcessArray);
+            checkChildProcesses(jobTable);
 
         // free dyn allocated memory:
-        freeMem(newCommand);
+        freeCommandList(commandList);
     }
 }
 
@@ -83,23 +138,28 @@ void runShell(){
 * Desc:     creates new command struct and gets user input. it allows for 2048
 *           characters and 512 arguments within those characters. if a user
 *           enters $$, this is expanded to the process id of smallsh. the input
-*           string is parsed to create the command struct which gets returned.
+*           string is parsed to create the command list (one struct per command
+*           separated by ;, && or ||) and the first struct is returned.
 *******************************************************************************/
 struct command* prompt(){
     // holds user's input:
     char* input;
 
     // new struct to get populated with user's input:
-    struct command* newCommand = malloc(sizeof(struct command));
+    struct command* newCommand = trackedMalloc(sizeof(struct command));
 
     // 2048 characters permitted, but must make space for /n and /0:
     int numChars = 2048;
-    input = (char*)malloc((numChars + 2) * sizeof(char));
+    input = (char*)trackedMalloc((numChars + 2) * sizeof(char));
 
     // get input:
     printf(": ");
     fflush(stdout);
-    fgets(input, numChars + 2, stdin);
+
+    // end of input (^D or end of piped script) is treated as exit so the
+    // shell never loops on a stale buffer:
+    if (fgets(input, numChars + 2, stdin) == NULL)
+        strcpy(input, "exit\n");
 
     // if $$ is entered anywhere, replace with smallsh pid:
     input = expandAny$$(input);
@@ -110,7 +170,16 @@ struct command* prompt(){
 
     // parse string by spaces and populate command struct:
     parseString(input, " ", newCommand);
-    free(input);
+    trackedFree(input);
+
+    // read any here-document bodies in order, a bad one leaves an empty
+    // command:
+    for(struct command* cmd = newCommand; cmd != NULL; cmd = cmd->next){
+        if(!collectHereDoc(cmd)){
+            trackedFree(cmd->pathname);
+            cmd->pathname = NULL;
+        }
+    }
 
     return newCommand;
 }
@@ -118,46 +187,202 @@ struct command* prompt(){
 /*******************************************************************************
 * Function: parseString
 * Desc:     function receives the string to be parsed, the string to use as a
-*           delimiter, and the command struct to populate. nothing is returned
-*           since data is saved to memory addresses.
+*           delimiter, and the command struct to populate. a ;, && or || token
+*           ends the current command and starts a new struct linked through
+*           next, so one pass over the line builds the whole command list.
+*           operators need not be surrounded by the delimiter ("a; b" and
+*           "a&&b" split as expected). a list that fails checkCommandList is
+*           discarded and leaves one empty command. nothing is returned since
+*           data is saved to memory addresses.
 *******************************************************************************/
 void parseString(char* str, char* delim, struct command* newCommand){
     int i = 0; // used for storing args in indices
     char* saveptr = NULL;
+    char* spaced = NULL; // copy of str with operators set apart
+    enum connector connector;
+    struct command* current = newCommand; // command receiving tokens
+    struct command* rejected = NULL;      // heap copy of a bad list to free
 
-    // 512 arguments allowed (513 extra slot needed for NULL indicator):
-    newCommand->args = malloc(513 * sizeof(char*));
-    initArgArray(newCommand);
+    initCommand(newCommand, connectNone);
 
-    // if input starts with enter or is # then set pathname to null:
-    if (str[0] == '\n' || str[0] == '#'){
-        newCommand->pathname = NULL;
+    // if input starts with enter or is # then leave pathname null:
+    if (str[0] == '\n' || str[0] == '#')
         return;
-    }
 
-    // first token represents the pathname of the command:
-    char* token = strtok_r(str, delim, &saveptr);
-    newCommand->pathname = calloc(strlen(token) + 1, sizeof(char));
-    strcpy(newCommand->pathname, token);
+    spaced = separateOperators(str, delim[0]);
+    char* token = strtok_r(spaced, delim, &saveptr);
 
-    // first token pathname is also saved in args[0] index for execv function:
-    newCommand->args[i] = calloc(strlen(token) + 1, sizeof(char));
-    strcpy(newCommand->args[i], token);
-    ++i;
+    while(token != NULL){
+        connector = checkConnector(token);
+
+        // operator starts the next command in the list:
+        if(connector != connectNone){
+            current->next = trackedMalloc(sizeof(struct command));
+            current = current->next;
+            initCommand(current, connector);
+            i = 0;
+        }
+        // 512 arguments allowed per command, extras are dropped:
+        else if(i < 512){
+            // first token represents the pathname of the command:
+            if(i == 0){
+                current->pathname = trackedCalloc(strlen(token) + 1,
+                                                  sizeof(char));
+                strcpy(current->pathname, token);
+            }
 
-    // move to next index:
-    token = strtok_r(NULL, delim, &saveptr);
+            // pathname is also saved in args[0] index for execv function:
+            current->args[i] = trackedCalloc(strlen(token) + 1, sizeof(char));
+            strcpy(current->args[i], token);
+            ++i;
+        }
 
-    // add all remaining commands to args array:
-    while(token != NULL){
-        newCommand->args[i] = calloc(strlen(token) + 1, sizeof(char));
-        strcpy(newCommand->args[i], token);
-        ++i;
         token = strtok_r(NULL, delim, &saveptr);
     }
 
-    // NULL used for indicating:
-    newCommand->args[i] = NULL;
+    trackedFree(spaced);
+
+    // a syntax error runs nothing, not even the commands before it:
+    if(!checkCommandList(newCommand)){
+        rejected = trackedMalloc(sizeof(struct command));
+        *rejected = *newCommand;
+        freeCommandList(rejected);
+        initCommand(newCommand, connectNone);
+    }
+}
+
+/*******************************************************************************
+* Function: checkCommandList
+* Desc:     function receives the first command struct of a parsed list and
+*           checks that every operator has a command before it, and that && and
+*           || also have one after it (a trailing ; is allowed). prints a
+*           syntax error and returns false otherwise.
+*******************************************************************************/
+bool checkCommandList(struct command* commandList){
+
+    // operator text indexed by enum connector:
+    char* operators[] = {"", ";", "&&", "||"};
+
+    for(struct command* cmd = commandList; cmd != NULL; cmd = cmd->next){
+        if(cmd->pathname != NULL)
+            continue;
+
+        if(cmd->next != NULL){
+            printf("syntax error: missing command before %s\n",
+                   operators[cmd->next->connector]);
+            fflush(stdout);
+            return false;
+        }
+
+        if(cmd->connector == connectAnd || cmd->connector == connectOr){
+            printf("syntax error: missing command after %s\n",
+                   operators[cmd->connector]);
+            fflush(stdout);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function: separateOperators
+* Desc:     function receives a string and a separator character and returns a
+*           new string in which every ;, && and || has the separator on both
+*           sides, so strtok_r sees each operator as its own token. a single &
+*           or | is left alone. the caller frees the returned string.
+*******************************************************************************/
+char* separateOperators(char* str, char separator){
+    int j = 0;
+
+    // each operator char gains at most two separators:
+    char* spaced = trackedMalloc(strlen(str) * 3 + 1);
+
+    for(int i = 0; str[i] != '\0'; ++i){
+        if(str[i] == ';'){
+            spaced[j++] = separator;
+            spaced[j++] = ';';
+            spaced[j++] = separator;
+        }
+        else if((str[i] == '&' || str[i] == '|') && str[i+1] == str[i]){
+            spaced[j++] = separator;
+            spaced[j++] = str[i];
+            spaced[j++] = str[i];
+            spaced[j++] = separator;
+            ++i;
+        }
+        else
+            spaced[j++] = str[i];
+    }
+
+    spaced[j] = '\0';
+
+    return spaced;
+}
+
+/*******************************************************************************
+* Function: initCommand
+* Desc:     function receives a new command struct and the connector that
+*           joins it to the previous command. the args array is allocated and
+*           every other field starts empty.
+*******************************************************************************/
+void initCommand(struct command* newCommand, enum connector connector){
+
+    newCommand->pathname = NULL;
+
+    // 512 arguments allowed (513 extra slot needed for NULL indicator):
+    newCommand->args = trackedMalloc(513 * sizeof(char*));
+    initArgArray(newCommand);
+
+    // no stdin text until collectHereDoc finds << or <<<:
+    newCommand->hasHereDoc = false;
+    newCommand->hereDoc = NULL;
+    newCommand->hereDocLen = 0;
+
+    newCommand->connector = connector;
+    newCommand->next = NULL;
+}
+
+/*******************************************************************************
+* Function: checkConnector
+* Desc:     function receives a token and returns the list operator it names,
+*           or connectNone if it is an ordinary argument.
+*******************************************************************************/
+enum connector checkConnector(char* token){
+
+    if(strcmp(token, ";") == 0)
+        return connectSequence;
+
+    if(strcmp(token, "&&") == 0)
+        return connectAnd;
+
+    if(strcmp(token, "||") == 0)
+        return connectOr;
+
+    return connectNone;
+}
+
+/*******************************************************************************
+* Function: shouldRunCommand
+* Desc:     function receives a command from the list and the status of the
+*           last command run. commands after && run only if it succeeded and
+*           commands after || only if it failed. built-in commands that worked
+*           (INT_MIN) and background launches count as success, failing
+*           built-ins return exit status 1. returns true if the command should
+*           run.
+*******************************************************************************/
+bool shouldRunCommand(struct command* newCommand, int status){
+
+    bool succeeded = status == INT_MIN ||
+                     (WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    if(newCommand->connector == connectAnd)
+        return succeeded;
+
+    if(newCommand->connector == connectOr)
+        return !succeeded;
+
+    return true;
 }
 
 /*******************************************************************************
@@ -167,14 +392,32 @@ void parseString(char* str, char* delim, struct command* newCommand){
 *******************************************************************************/
 void freeMem(struct command* newCommand){
 
-    free(newCommand->pathname);
+    trackedFree(newCommand->pathname);
 
     for (int i = 0; i < 513; ++i)
-        free(newCommand->args[i]);
+        trackedFree(newCommand->args[i]);
+
+    trackedFree(newCommand->args);
+
+    trackedFree(newCommand->hereDoc);
 
-    free(newCommand->args);
+    trackedFree(newCommand);
+}
+
+/*******************************************************************************
+* Function: freeCommandList
+* Desc:     function receives the first command struct of a list and frees
+*           every command in it.
+*******************************************************************************/
+void freeCommandList(struct command* commandList){
 
-    free(newCommand);
+    struct command* next;
+
+    while(commandList != NULL){
+        next = commandList->next;
+        freeMem(commandList);
+        commandList = next;
+    }
 }
 
 /*******************************************************************************
@@ -197,7 +440,22 @@ int checkCommand(char* arg){
 
     if(strcmp(arg, "status") == 0)
         return 2;
-    
+
+    if(strcmp(arg, "memstats") == 0)
+        return 5;
+
+    if(strcmp(arg, "jobs") == 0)
+        return 6;
+
+    if(strcmp(arg, "fg") == 0)
+        return 7;
+
+    if(strcmp(arg, "bg") == 0)
+        return 8;
+
+    if(strcmp(arg, "batch") == 0)
+        return 9;
+
     return 3;      // other (enum in runShell)
 }
 
@@ -229,6 +487,8 @@ int runStatus(int status){
 
     if(WIFEXITED(status)) // terminated normally:
         printf("exit value %d\n", WEXITSTATUS(status));
+    else if(WIFSTOPPED(status)) // suspended, still held in job table:
+        printf("stopped by signal %d\n", WSTOPSIG(status));
     else // did not terminate normally:
         printf("terminated by signal %d\n", WTERMSIG(status));
 
@@ -242,7 +502,9 @@ int runStatus(int status){
 * Function: runCd
 * Desc:     this is a built-in function. the function receives a command struct
 *           and gets the 2nd argument passed from the user. the second argument
-*           is the file path to be used with chdir (if not empty).
+*           is the file path to be used with chdir (if not empty). returns
+*           INT_MIN, or exit status 1 if the directory could not be entered so
+*           && and || see the failure.
 *******************************************************************************/
 int runCd(struct command* newCommand){
     char* home = getenv("HOME");
@@ -253,12 +515,15 @@ int runCd(struct command* newCommand){
         command = NULL;
 
     // if there is no 2nd argument or it's ~, send user to home dir:
-    if(command == NULL || strcmp(command, "~") == 0)
-        chdir(home);
+    if(command == NULL || strcmp(command, "~") == 0){
+        if(home == NULL || chdir(home) != 0)
+            return W_EXITCODE(1, 0);
+    }
     // else take user to 2nd argument path or catch error:
     else if (chdir(command) != 0){
         printf(": cd: %s: no such file or directory\n", command);
         fflush(stdout);
+        return W_EXITCODE(1, 0);
     }
 
     // cd is built-in function so return INT_MIN as indicator to status:
@@ -269,15 +534,17 @@ int runCd(struct command* newCommand){
 * Function: runOther
 * Desc:     runs non-built in commands by the user. these include all those
 *           outside of cd, status, and exit. the function recieves a command
-*           struct and the child process array. it's status is returned to the
+*           struct and the job table. each child leads its own process group so
+*           the job (and anything it spawns) can be signaled with one killpg.
+*           foreground jobs are handed the terminal while the shell waits, so
+*           ^Z stops the job rather than toggling foreground-only mode (which
+*           ^Z still does at the prompt). it's status is returned to the
 *           calling function, runShell.
-*           
-*         
 *******************************************************************************/
-int runOther(struct command* newCommand, int* childProcessArray){
+int runOther(struct command* newCommand, struct jobTable* jobTable){
 
-    int spawnStatus;
-    int childPid = INT_MIN;
+    int spawnStatus = 0;
+    struct job* newJob = NULL;
 
     // check if process should be run in the background:
     bool isBackProc = isBackgroundProcess(newCommand->args);
@@ -298,24 +565,28 @@ int runOther(struct command* newCommand, int* childProcessArray){
             exit(1);
             break;
         case 0:
-            childPid = getpid();
+            // child becomes leader of a new process group for the job:
+            setpgid(0, 0);
 
-            // ignore SIGTSTP (^Z):
-            ignoreSIGTSTP();
+            // foreground job takes the terminal so ^C reaches only it:
+            if(!isBackProc)
+                giveTerminalTo(getpid());
 
-            // notify user of background pid, if in background mode:
-            if(isBackProc){
-                printf("background pid is %d\n", childPid);
-                fflush(stdout);
-            }
-            else // set SIGINT (^C)to default so foreground child responds:
-                signal(SIGINT, SIG_DFL);
+            // ^Z stops the job (it reaches only the terminal's foreground
+            // group, so the shell's foreground-only toggle is unaffected):
+            signal(SIGTSTP, SIG_DFL);
+
+            // terminal access signals ignored by the shell go back to default:
+            signal(SIGTTOU, SIG_DFL);
+            signal(SIGTTIN, SIG_DFL);
 
-            // check if redirection is not needed, if so use execvp function
-            if(!redirNeeded(newCommand, fdArray, isBackProc))
-                execvp(newCommand->pathname, newCommand->args);
-            else // redirection is needed so used execlp:
-                execlp(newCommand->pathname, newCommand->pathname, NULL);
+            // set SIGINT (^C) to default in every job so one resumed with fg
+            // responds; background jobs are kept from ^C by their own group:
+            signal(SIGINT, SIG_DFL);
+
+            // set up redirection (removing its args), then run the command:
+            redirNeeded(newCommand, fdArray, isBackProc);
+            execvp(newCommand->pathname, newCommand->args);
 
             // exec error printing (child only returns due to error):
             printf("%s: no such file or directory\n", newCommand->pathname);
@@ -323,20 +594,32 @@ int runOther(struct command* newCommand, int* childProcessArray){
             freeMem(newCommand);          // free dyn memory of child process
             exit(1);
         default:
-            if(isBackProc){
-                /* if it's run in the background, add child to child process
-                array for tracking within runShell */
-                addChildProcess(childProcessArray, spawnId);
+            // also set in parent so the group exists before either side
+            // relies on it (whichever runs first wins, the other is a no-op):
+            setpgid(spawnId, spawnId);
 
-                // returns 0 if parent isn't waiting for child to finish
-                spawnId = waitpid(spawnId, &spawnStatus, WNOHANG);
-
-                // sleep to allow time for smallsh to print ":"
-                sleep(1);
+            if(isBackProc){
+                /* if it's run in the background, add child to job table for
+                tracking within runShell */
+                addJob(jobTable, spawnId, buildCommandLine(newCommand->args),
+                       jobRunning);
+
+                // notify user of background pid (printed by the parent so no
+                // delay is needed to keep it ahead of the next prompt):
+                printf("background pid is %d\n", spawnId);
+                fflush(stdout);
             }
             else {
-                spawnId = waitpid(spawnId, &spawnStatus, 0);
-                // printf("spawnId = %d\n", spawnId);
+                spawnStatus = waitForeground(spawnId);
+
+                // a stopped foreground job is kept so fg/bg can resume it:
+                if(WIFSTOPPED(spawnStatus)){
+                    newJob = addJob(jobTable, spawnId,
+                                    buildCommandLine(newCommand->args),
+                                    jobStopped);
+                    printf("\n[%d] stopped %s\n", newJob->id, newJob->cmdLine);
+                    fflush(stdout);
+                }
             }
             break;
     }
@@ -358,11 +641,11 @@ char* expandAny$$(char* str){
     int j = 0;           // for incrementing expanded char array below
 
     // hold process id in c-string, up to 10 chars:
-    char* pidChar = malloc(11 * sizeof(char));
+    char* pidChar = trackedMalloc(11 * sizeof(char));
     sprintf(pidChar, "%d", getpid());
 
     // new string to hold expanded string:
-    char* expandedStr = malloc(strlen(str) * sizeof(pidChar));
+    char* expandedStr = trackedMalloc(strlen(str) * sizeof(pidChar));
 
     // expand $$ occurences:
     while (str[i] != '\0'){
@@ -404,8 +687,8 @@ char* expandAny$$(char* str){
     expandedStr[j] = '\0';
 
     // free dyn memory of process id and passed in old string:
-    free(pidChar);
-    free(str);
+    trackedFree(pidChar);
+    trackedFree(str);
 
     return expandedStr;
 }
@@ -416,7 +699,9 @@ char* expandAny$$(char* str){
 *           the user entered < to redirect stdout and > to redirect stdin. the
 *           redirected input is opened for read only. the output is opened for
 *           write only, truncating if already exist or create new. both of these
-*           redirections can occur at once.
+*           redirections can occur at once. a here-document or here-string
+*           collected at the prompt becomes stdin unless < is also given.
+*           the redirection args are removed so the command sees only its own.
 *           
 *           the function returns true if redirection is needed and false if it 
 *           is not.
@@ -433,8 +718,22 @@ bool redirNeeded(struct command* newCommand, int* fdArray, bool isBackProc){
     char* targetFileName;
     char** args = newCommand->args;
 
+    // every redirection opens one fd, so args count bounds the fds needed
+    // (plus a here-document, two /dev/null fds and the terminator):
+    while(args[i] != NULL)
+        ++i;
+
     // create int array for hold FDs to close later:
-    fdArray = (int*)malloc(10 * sizeof(int));
+    fdArray = (int*)trackedMalloc((i + 4) * sizeof(int));
+    i = 0;
+
+    // here-document body (collected by prompt) is the default source:
+    if(newCommand->hasHereDoc){
+        sourceFileName = "here-document";
+        sourceFD = openHereDoc(newCommand);
+        fdArray[j++] = sourceFD;
+        sourceRedirect = true;
+    }
 
     while(args[i] != NULL){
         // look for target redirection and filename will trail it:
@@ -457,13 +756,17 @@ bool redirNeeded(struct command* newCommand, int* fdArray, bool isBackProc){
 
     // no source redirect specified and process is ran in background
     // therefore stdin redirected to /dev/null:
-    if(!sourceRedirect && isBackProc)
+    if(!sourceRedirect && isBackProc){
         sourceFD = open("/dev/null", O_RDONLY);
+        fdArray[j++] = sourceFD;
+    }
 
     // no target redirect specified and process is ran in background
     // therefore stdout redirected to /dev/null:
-    if(!targetRedirect && isBackProc)
+    if(!targetRedirect && isBackProc){
         targetFD = open("/dev/null", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        fdArray[j++] = targetFD;
+    }
 
     fdArray[j] = INT_MIN; // INT_MIN used as end of array terminator
 
@@ -471,7 +774,7 @@ bool redirNeeded(struct command* newCommand, int* fdArray, bool isBackProc){
     if(sourceRedirect && sourceFD == -1){
         printf("cannot open %s for input\n", sourceFileName);
         fflush(stdout);
-        free(fdArray);
+        trackedFree(fdArray);
         freeMem(newCommand);
         exit(1);
     }
@@ -480,41 +783,285 @@ bool redirNeeded(struct command* newCommand, int* fdArray, bool isBackProc){
     if(targetRedirect && targetFD == -1){
         printf("cannot open %s for output\n", targetFileName);
         fflush(stdout);
-        free(fdArray);
+        trackedFree(fdArray);
         freeMem(newCommand);
         exit(1);
     }
 
-    if(sourceRedirect){
-        // redirect stdin to source file:
+    if(sourceRedirect || isBackProc){
+        // redirect stdin to source file (or /dev/null):
         result = dup2(sourceFD, 0);
         if (result == -1){
             perror("source dup2()");
-            free(fdArray);
+            trackedFree(fdArray);
             freeMem(newCommand);
             exit(2);
         }
     }
 
-    if(targetRedirect){
-        // redirect stdout to target file:
+    if(targetRedirect || isBackProc){
+        // redirect stdout to target file (or /dev/null):
         result = dup2(targetFD, 1);
         if (result == -1){
             perror("target dup2()");
-            free(fdArray);
+            trackedFree(fdArray);
             freeMem(newCommand);
             exit(2);
         }
     }
 
-    if(!sourceRedirect && !targetRedirect){
-        free(fdArray); // fdArray not used
-        return false;
+    // stdin/stdout now hold duplicates, so the originals are closed rather
+    // than inherited by the exec'd program:
+    closeFDArray(fdArray);
+    trackedFree(fdArray);
+
+    removeRedirArgs(args);
+
+    return sourceRedirect || targetRedirect;
+}
+
+/*******************************************************************************
+* Function: removeRedirArgs
+* Desc:     function receives the args array after redirection is set up and
+*           removes each < or > operator along with its filename, shifting the
+*           remaining args down. the freed slots are set to NULL so freeMem
+*           does not free them twice.
+*******************************************************************************/
+void removeRedirArgs(char** args){
+    int i = 0; // index of arg being examined
+    int k = 0; // index the next kept arg is stored at
+
+    while(args[i] != NULL){
+        if((strcmp(args[i], "<") == 0 || strcmp(args[i], ">") == 0) &&
+           args[i+1] != NULL){
+            trackedFree(args[i]);
+            trackedFree(args[i+1]);
+            i += 2;
+            continue;
+        }
+        args[k++] = args[i++];
+    }
+
+    // clear the slots vacated by shifting:
+    while(k < i)
+        args[k++] = NULL;
+}
+
+/*******************************************************************************
+* Function: closeFDArray
+* Desc:     function receives an INT_MIN terminated array of file descriptors
+*           opened by redirNeeded and closes each one. descriptors that failed
+*           to open or already sit on stdin/stdout/stderr are left alone.
+*******************************************************************************/
+void closeFDArray(int* fdArray){
+
+    for(int i = 0; fdArray[i] != INT_MIN; ++i){
+        if(fdArray[i] > STDERR_FILENO)
+            close(fdArray[i]);
     }
+}
+
+/*******************************************************************************
+* Function: collectHereDoc
+* Desc:     function receives a parsed command struct and looks for here-string
+*           (<<< word) and here-document (<<WORD) operators, with or without a
+*           space before the word. a here-string's word plus a newline becomes
+*           stdin text. a here-document reads following input lines until one
+*           matches WORD, expanding $$ in each unless WORD is quoted ('EOF' or
+*           "EOF"). the operators are removed from args, and the text is kept in
+*           the command struct for redirNeeded. if more than one is given the
+*           last wins. returns false if an operator has no word.
+*******************************************************************************/
+bool collectHereDoc(struct command* newCommand){
+    char** args = newCommand->args;
+    char* word;         // here-string text or here-document delimiter
+    char* line;         // here-document body line
+    size_t capacity;    // bytes allocated for the body being built
+    size_t len;
+    bool expand;
+    bool isHereString;
+    int i = 1;          // args[0] is the command name
+    int k = 1;          // index the next kept arg is stored at
+    int used;           // args consumed by the operator
+
+    while(args[i] != NULL){
+        isHereString = strncmp(args[i], "<<<", 3) == 0;
+
+        // keep args that are not here-document operators:
+        if(!isHereString && strncmp(args[i], "<<", 2) != 0){
+            args[k++] = args[i++];
+            continue;
+        }
+
+        // word is either attached to the operator or the next arg:
+        word = args[i] + (isHereString ? 3 : 2);
+        used = 1;
+        if(*word == '\0'){
+            word = args[i+1];
+            used = 2;
+        }
+
+        if(word == NULL){
+            printf("syntax error: missing word after %s\n", args[i]);
+            fflush(stdout);
+            // keep remaining args in place so freeMem still frees them:
+            while(args[i] != NULL)
+                args[k++] = args[i++];
+            while(k < i)
+                args[k++] = NULL;
+            return false;
+        }
+
+        // a later operator replaces an earlier one, and an empty body
+        // still counts (stdin is at EOF rather than inherited):
+        trackedFree(newCommand->hereDoc);
+        newCommand->hasHereDoc = true;
+        newCommand->hereDoc = NULL;
+        newCommand->hereDocLen = 0;
+        capacity = 0;
+
+        if(isHereString){
+            // already $$-expanded with the rest of the line:
+            appendHereDoc(newCommand, word, strlen(word), &capacity);
+            appendHereDoc(newCommand, "\n", 1, &capacity);
+        }
+        else {
+            // quoted delimiter disables expansion in the body:
+            len = strlen(word);
+            expand = true;
+            if(len >= 2 && (word[0] == '\'' || word[0] == '"') &&
+               word[len - 1] == word[0]){
+                word[len - 1] = '\0';
+                ++word;
+                expand = false;
+            }
+
+            // same 2048 character limit as prompt, plus \n and \0:
+            line = trackedMalloc(2048 + 2);
+
+            while(true){
+                // continuation prompt only when a person is typing:
+                if(interactive){
+                    printf("> ");
+                    fflush(stdout);
+                }
+
+                // end of input also ends the body:
+                if(fgets(line, 2048 + 2, stdin) == NULL)
+                    break;
+
+                len = strlen(line);
+                if(len > 0 && line[len - 1] == '\n')
+                    --len;
+                if(len == strlen(word) && strncmp(line, word, len) == 0)
+                    break;
+
+                if(expand && strstr(line, "$$") != NULL){
+                    // expandAny$$ frees the buffer and returns a new one:
+                    line = expandAny$$(line);
+                    appendHereDoc(newCommand, line, strlen(line), &capacity);
+                    trackedFree(line);
+                    line = trackedMalloc(2048 + 2);
+                }
+                else
+                    appendHereDoc(newCommand, line, strlen(line), &capacity);
+            }
+
+            trackedFree(line);
+        }
+
+        // operator (and detached word) are consumed:
+        for(int m = 0; m < used; ++m)
+            trackedFree(args[i + m]);
+        i += used;
+    }
+
+    // clear the slots vacated by shifting:
+    while(k < i)
+        args[k++] = NULL;
 
     return true;
 }
 
+/*******************************************************************************
+* Function: appendHereDoc
+* Desc:     function appends len bytes of text to the command's here-document
+*           body, doubling the allocation (tracked through capacity) as needed
+*           so long bodies are built in linear time.
+*******************************************************************************/
+void appendHereDoc(struct command* newCommand, char* text, size_t len,
+                   size_t* capacity){
+
+    size_t needed = newCommand->hereDocLen + len;
+
+    if(needed > *capacity){
+        *capacity = *capacity == 0 ? 256 : *capacity;
+        while(*capacity < needed)
+            *capacity *= 2;
+        newCommand->hereDoc = trackedRealloc(newCommand->hereDoc, *capacity);
+    }
+
+    memcpy(newCommand->hereDoc + newCommand->hereDocLen, text, len);
+    newCommand->hereDocLen = needed;
+}
+
+/*******************************************************************************
+* Function: openHereDoc
+* Desc:     function is called in the child and returns a readable file
+*           descriptor positioned at the start of the command's here-document
+*           body, so the text never touches the filesystem. bodies up to
+*           PIPE_BUF fit in a pipe without blocking. larger bodies go in a
+*           memfd_create file, falling back to an unlinked temp file on kernels
+*           without memfd. returns -1 if no descriptor could be made.
+*******************************************************************************/
+int openHereDoc(struct command* newCommand){
+    int pipeFDs[2];
+    int fd;
+    char tempName[] = "/tmp/smallsh-heredoc-XXXXXX";
+    char* text = newCommand->hereDoc;
+    size_t left = newCommand->hereDocLen;
+    ssize_t written;
+
+    // small (or empty) body: write it all into a pipe, reader sees EOF
+    // after it:
+    if(left <= PIPE_BUF){
+        if(pipe(pipeFDs) == -1)
+            return -1;
+        written = left > 0 ? write(pipeFDs[1], text, left) : 0;
+        close(pipeFDs[1]);
+        if(written != (ssize_t)left){
+            close(pipeFDs[0]);
+            return -1;
+        }
+        return pipeFDs[0];
+    }
+
+    // large body: anonymous in-memory file:
+    fd = memfd_create("smallsh-heredoc", MFD_CLOEXEC);
+
+    if(fd == -1){
+        fd = mkstemp(tempName);
+        if(fd == -1)
+            return -1;
+        unlink(tempName);
+    }
+
+    while(left > 0){
+        written = write(fd, text, left);
+        if(written == -1){
+            close(fd);
+            return -1;
+        }
+        text += written;
+        left -= written;
+    }
+
+    // rewind so the command reads from the start:
+    lseek(fd, 0, SEEK_SET);
+
+    return fd;
+}
+
 /*******************************************************************************
 * Function: isBackgroundProcess
 * Desc:     function returns an array of strings representing all the args
@@ -527,7 +1074,8 @@ bool isBackgroundProcess(char** args){
 
     while(args[i] != NULL){
         if(strcmp(args[i], "&") == 0 && args[i + 1] == NULL){
-            args[i] = NULL; // remove & from args array
+            trackedFree(args[i]); // freeMem no longer sees this slot
+            args[i] = NULL;       // remove & from args array
             return true;
         }
         ++i;
@@ -537,14 +1085,15 @@ bool isBackgroundProcess(char** args){
 }
 
 /*******************************************************************************
-* Function: initProcArray
-* Desc:     initializes child process list created in runShell to hold values of
-*           zero.
+* Function: initJobTable
+* Desc:     initializes the job table created in runShell to hold no jobs.
+*           storage is allocated as jobs are added.
 *******************************************************************************/
-void initProcArray(int* childProcessArray){
+void initJobTable(struct jobTable* jobTable){
 
-    for (int i = 0; i < 100; ++i)
-        childProcessArray[i] = 0;
+    jobTable->jobs = NULL;
+    jobTable->count = 0;
+    jobTable->capacity = 0;
 }
 
 /*******************************************************************************
@@ -558,49 +1107,664 @@ void initArgArray(struct command* newCommand){
 }
 
 /*******************************************************************************
-* Function: addChildProcess
-* Desc:     function receives child process array and adds integer to it which
-*           represents the background processed child. calling funciton is
-*           runOther.
+* Function: addJob
+* Desc:     function receives the job table, the process group of a new job,
+*           its command text, and its state. the job is appended with the next
+*           job number, growing the table when full. the table takes ownership
+*           of cmdLine. returns a pointer to the new entry.
 *******************************************************************************/
-void addChildProcess(int* childProcessArray, int childPid){
+struct job* addJob(struct jobTable* jobTable, pid_t pgid, char* cmdLine,
+                   enum jobState state){
+
+    struct job* jobs;
+
+    // double storage when table is full:
+    if(jobTable->count == jobTable->capacity){
+        int capacity = jobTable->capacity == 0 ? 16 : jobTable->capacity * 2;
+        jobs = trackedMalloc(capacity * sizeof(struct job));
+        if(jobTable->count > 0)
+            memcpy(jobs, jobTable->jobs, jobTable->count * sizeof(struct job));
+        trackedFree(jobTable->jobs);
+        jobTable->jobs = jobs;
+        jobTable->capacity = capacity;
+    }
 
-    for (int i = 0; i < 100; ++i){
-        if(childProcessArray[i] == 0){
-            childProcessArray[i] = childPid;
-            break;
-        }
+    struct job* newJob = &jobTable->jobs[jobTable->count];
+
+    // jobs are kept in launch order, so the last one has the highest number:
+    if(jobTable->count == 0)
+        newJob->id = 1;
+    else
+        newJob->id = jobTable->jobs[jobTable->count - 1].id + 1;
+
+    newJob->pgid = pgid;
+    newJob->cmdLine = cmdLine;
+    newJob->state = state;
+    jobTable->count++;
+
+    return newJob;
+}
+
+/*******************************************************************************
+* Function: removeJob
+* Desc:     function receives the job table and the index of a finished job. the
+*           job's command text is freed and later jobs shift down so launch
+*           order is preserved.
+*******************************************************************************/
+void removeJob(struct jobTable* jobTable, int index){
+
+    trackedFree(jobTable->jobs[index].cmdLine);
+
+    memmove(&jobTable->jobs[index], &jobTable->jobs[index + 1],
+            (jobTable->count - index - 1) * sizeof(struct job));
+
+    jobTable->count--;
+}
+
+/*******************************************************************************
+* Function: findJobIndex
+* Desc:     function receives the job table and a process group id and returns
+*           the index of the matching job, or -1 if it is not tracked.
+*******************************************************************************/
+int findJobIndex(struct jobTable* jobTable, pid_t pgid){
+
+    for(int i = 0; i < jobTable->count; ++i){
+        if(jobTable->jobs[i].pgid == pgid)
+            return i;
     }
+
+    return -1;
 }
 
 /*******************************************************************************
 * Function: checkChildProcesses
-* Desc:     function receives child process array and checks each one to see if
-*           they are still running. if so, no action is taken. if not, the
-*           background pid is printed and the child pid is removed from the
-*           array.
+* Desc:     function receives the job table and collects every child that has
+*           finished or stopped since the last check. finished jobs have their
+*           background pid printed and are removed from the table. stopped jobs
+*           are marked so fg/bg can resume them. one waitpid call is made per
+*           state change rather than one per tracked job.
 *******************************************************************************/
-void checkChildProcesses(int* childProcessArray){
+void checkChildProcesses(struct jobTable* jobTable){
 
     int childId;
     int childIdStatus;
+    int index;
+
+    // returns 0 once no more children have changed state:
+    while((childId = waitpid(-1, &childIdStatus, WNOHANG | WUNTRACED)) > 0){
+
+        index = findJobIndex(jobTable, childId);
+        if(index == -1)
+            continue;
+
+        if(WIFSTOPPED(childIdStatus)){
+            jobTable->jobs[index].state = jobStopped;
+            printf("[%d] stopped %s\n", jobTable->jobs[index].id,
+                   jobTable->jobs[index].cmdLine);
+            fflush(stdout);
+        }
+        else {
+            printf("background pid %d is done: ", childId);
+            fflush(stdout);
+            runStatus(childIdStatus); // prints exit status
+            removeJob(jobTable, index); // remove job from table
+        }
+    }
+}
+
+/*******************************************************************************
+* Function: initJobControl
+* Desc:     function records whether smallsh is reading from a terminal and the
+*           shell's own process group. when interactive, SIGTTOU and SIGTTIN
+*           are ignored so the shell can take the terminal back with tcsetpgrp
+*           after a foreground job finishes.
+*******************************************************************************/
+void initJobControl(){
+
+    interactive = isatty(STDIN_FILENO);
+    shellPgid = getpgrp();
+
+    if(interactive){
+        signal(SIGTTOU, SIG_IGN);
+        signal(SIGTTIN, SIG_IGN);
+    }
+}
+
+/*******************************************************************************
+* Function: giveTerminalTo
+* Desc:     function makes the received process group the terminal's
+*           foreground group. nothing is done when the shell is not reading
+*           from a terminal.
+*******************************************************************************/
+void giveTerminalTo(pid_t pgid){
+
+    if(interactive)
+        tcsetpgrp(STDIN_FILENO, pgid);
+}
+
+/*******************************************************************************
+* Function: waitForeground
+* Desc:     function hands the terminal to the received process group and
+*           waits for its leader to exit or stop, then takes the terminal back
+*           for the shell. the wait status is returned.
+*******************************************************************************/
+int waitForeground(pid_t pgid){
+
+    int spawnStatus = 0;
+
+    giveTerminalTo(pgid);
+
+    // retry if interrupted by the SIGTSTP handler:
+    while(waitpid(pgid, &spawnStatus, WUNTRACED) == -1 && errno == EINTR)
+        ;
+
+    giveTerminalTo(shellPgid);
+
+    return spawnStatus;
+}
+
+/*******************************************************************************
+* Function: buildCommandLine
+* Desc:     function receives a NULL terminated args array and joins the args
+*           with spaces. the returned string is the command text shown by jobs
+*           and is freed when the job is removed from the job table.
+*******************************************************************************/
+char* buildCommandLine(char** args){
+
+    size_t len = 1;   // room for \0
+    int i = 0;
+
+    while(args[i] != NULL)
+        len += strlen(args[i++]) + 1;
+
+    char* cmdLine = trackedCalloc(len, sizeof(char));
+
+    for(i = 0; args[i] != NULL; ++i){
+        if(i > 0)
+            strcat(cmdLine, " ");
+        strcat(cmdLine, args[i]);
+    }
+
+    return cmdLine;
+}
+
+/*******************************************************************************
+* Function: findJobSpec
+* Desc:     function receives the job table and the job argument given to fg or
+*           bg (%n or n). with no argument the most recent job is used. returns
+*           the index of the job, or -1 after printing an error if there is no
+*           such job.
+*******************************************************************************/
+int findJobSpec(struct jobTable* jobTable, char* builtin, char* spec){
+
+    int id;
+    char* end;
+
+    // no job given (or just &), use the most recent one:
+    if(spec == NULL || strcmp(spec, "&") == 0){
+        if(jobTable->count == 0){
+            printf(": %s: no current job\n", builtin);
+            fflush(stdout);
+            return -1;
+        }
+        return jobTable->count - 1;
+    }
+
+    // % prefix is optional:
+    id = strtol(spec[0] == '%' ? spec + 1 : spec, &end, 10);
+
+    if(*end == '\0'){
+        for(int i = 0; i < jobTable->count; ++i){
+            if(jobTable->jobs[i].id == id)
+                return i;
+        }
+    }
+
+    printf(": %s: %s: no such job\n", builtin, spec);
+    fflush(stdout);
+
+    return -1;
+}
+
+/*******************************************************************************
+* Function: runJobs
+* Desc:     this is a built-in function. it receives the job table and lists
+*           each job's number, state, process group, and command text. jobs
+*           that changed state since the last reap are collected first. returns
+*           INT_MIN to indicate a built-in command.
+*******************************************************************************/
+int runJobs(struct jobTable* jobTable){
+
+    struct job* job;
+
+    // earlier commands on the line may have let jobs finish or stop:
+    checkChildProcesses(jobTable);
+
+    for(int i = 0; i < jobTable->count; ++i){
+        job = &jobTable->jobs[i];
+        printf("[%d] %-8s %d %s\n", job->id,
+               job->state == jobStopped ? "Stopped" : "Running",
+               job->pgid, job->cmdLine);
+    }
+
+    fflush(stdout);
+
+    // jobs is built-in function so return INT_MIN as indicator to status:
+    return INT_MIN;
+}
+
+/*******************************************************************************
+* Function: runFg
+* Desc:     this is a built-in function. it receives a command struct and the
+*           job table. the job named by the 2nd argument is continued (with one
+*           killpg for its whole process group) and waited on in the
+*           foreground. a job that finishes is removed from the table, one that
+*           stops again stays in it. jobs are reaped before the lookup so one
+*           already done is reported, not waited on. the job's wait status is
+*           returned so status reports it, or exit status 1 if there is no such
+*           job.
+*******************************************************************************/
+int runFg(struct command* newCommand, struct jobTable* jobTable){
+
+    int spawnStatus;
+    int index;
+
+    checkChildProcesses(jobTable);
+    index = findJobSpec(jobTable, "fg", newCommand->args[1]);
+
+    if(index == -1)
+        return W_EXITCODE(1, 0);
+
+    struct job* job = &jobTable->jobs[index];
+    pid_t pgid = job->pgid;
+
+    printf("%s\n", job->cmdLine);
+    fflush(stdout);
+
+    job->state = jobRunning;
+    killpg(pgid, SIGCONT);
+
+    spawnStatus = waitForeground(pgid);
+
+    // table may not have moved, but look the job up again to be safe:
+    index = findJobIndex(jobTable, pgid);
+
+    if(WIFSTOPPED(spawnStatus)){
+        jobTable->jobs[index].state = jobStopped;
+        printf("\n[%d] stopped %s\n", jobTable->jobs[index].id,
+               jobTable->jobs[index].cmdLine);
+        fflush(stdout);
+    }
+    else
+        removeJob(jobTable, index);
+
+    return spawnStatus;
+}
+
+/*******************************************************************************
+* Function: runBg
+* Desc:     this is a built-in function. it receives a command struct and the
+*           job table, and continues the stopped job named by the 2nd argument
+*           in the background with one killpg for its whole process group. jobs
+*           are reaped first so a finished one is not named. returns INT_MIN
+*           to indicate a built-in command, or exit status 1 if there is no
+*           such job.
+*******************************************************************************/
+int runBg(struct command* newCommand, struct jobTable* jobTable){
+
+    int index;
+
+    checkChildProcesses(jobTable);
+    index = findJobSpec(jobTable, "bg", newCommand->args[1]);
+
+    if(index == -1)
+        return W_EXITCODE(1, 0);
 
-    for(int i = 0; i < 100; ++i){
-        if(childProcessArray[i] != 0){
+    struct job* job = &jobTable->jobs[index];
 
-            // check child process stored in child process array:
-            childId = waitpid(childProcessArray[i], &childIdStatus, WNOHANG);
+    job->state = jobRunning;
+    killpg(job->pgid, SIGCONT);
 
-            /* if child process is still running childId == 0, else it is equal
-             to original child process id when finished */
-            if(childId == childProcessArray[i]){
-                printf("background pid %d is done: ", childProcessArray[i]);
+    printf("[%d] %s &\n", job->id, job->cmdLine);
+    fflush(stdout);
+
+    // bg is built-in function so return INT_MIN as indicator to status:
+    return INT_MIN;
+}
+
+/*******************************************************************************
+* Function: runBatch
+* Desc:     this is a built-in function, similar to xargs. it receives a command
+*           struct of the form
+*
+*               batch [-P jobs] [-a file] command [args...] [< file] [> file]
+*
+*           and reads items (one per line, blank lines skipped) from the -a or
+*           < file, a here-document, or the shell's stdin. items are packed
+*           after the command's own args into argv lists as large as
+*           batchArgLimit allows, and the command is run once per list, with
+*           up to -P lists running at once (default 1). children read
+*           /dev/null and write to the > file if given. all batches share one
+*           foreground process group, or the shell's own group when items are
+*           typed at the terminal (the shell must keep the terminal to read
+*           them, and ^C still reaches the batches). no new batch starts after
+*           one is killed by a signal. returns the wait status of the first
+*           batch that failed, or of the last batch if all succeeded.
+*******************************************************************************/
+int runBatch(struct command* newCommand){
+    char** args = newCommand->args;
+    char* inFileName = NULL;
+    char* outFileName = NULL;
+    int maxJobs = 1;           // batches allowed to run at once
+    int running = 0;           // batches currently running
+    int i = 1;
+    int spawnStatus = 0;
+    int batchStatus = 0;       // status returned to runShell
+    bool failed = false;       // a batch has failed
+    bool stopLaunching = false;
+    bool keepTerminal;         // shell is reading items from the terminal
+    pid_t pgid = 0;            // process group of running batches
+    int outFD = -1;
+    FILE* input = stdin;
+    char** base = NULL;        // command and its own args
+    int baseCount = 0;
+    char** argv;               // base args plus packed items
+    int argvCount;
+    int argvCapacity;
+    char* pool;                // item text referenced by argv
+    size_t poolUsed = 0;
+    size_t used;               // bytes counted against the limit
+    size_t baseUsed = 0;
+    size_t itemLen;
+    bool wholeLine;            // line read up to and including its \n
+    char* line;
+    long limit = batchArgLimit();
+
+    // options come before the command:
+    while(args[i] != NULL && args[i][0] == '-'){
+        if(strcmp(args[i], "-P") == 0 && args[i+1] != NULL){
+            maxJobs = atoi(args[i+1]);
+            i += 2;
+        }
+        else if(strcmp(args[i], "-a") == 0 && args[i+1] != NULL){
+            inFileName = args[i+1];
+            i += 2;
+        }
+        else
+            break;
+    }
+
+    // remaining args are the command, less any redirection (and & which
+    // batch ignores, like cd):
+    base = trackedMalloc((513 + 1) * sizeof(char*));
+    for(; args[i] != NULL; ++i){
+        if((strcmp(args[i], "<") == 0 || strcmp(args[i], ">") == 0) &&
+           args[i+1] != NULL){
+            if(args[i][0] == '<')
+                inFileName = args[i+1];
+            else
+                outFileName = args[i+1];
+            ++i;
+        }
+        else if(strcmp(args[i], "&") != 0 || args[i+1] != NULL){
+            base[baseCount++] = args[i];
+            baseUsed += strlen(args[i]) + 1 + sizeof(char*);
+        }
+    }
+    base[baseCount] = NULL;
+
+    if(baseCount == 0 || maxJobs < 1 || (long)baseUsed >= limit){
+        printf("usage: batch [-P jobs] [-a file] command [args...]\n");
+        fflush(stdout);
+        trackedFree(base);
+        return W_EXITCODE(1, 0);
+    }
+
+    // item source: named file, here-document text, or the shell's stdin:
+    if(inFileName != NULL)
+        input = fopen(inFileName, "r");
+    else if(newCommand->hasHereDoc && newCommand->hereDocLen == 0)
+        input = fopen("/dev/null", "r");   // empty body, no items
+    else if(newCommand->hasHereDoc)
+        input = fmemopen(newCommand->hereDoc, newCommand->hereDocLen, "r");
+
+    // a batch group given the terminal would make the shell's reads of the
+    // remaining items fail with EIO, so batches join the shell's group:
+    keepTerminal = input == stdin && interactive;
+    if(keepTerminal)
+        pgid = shellPgid;
+
+    if(input == NULL){
+        printf("cannot open %s for input\n",
+               inFileName != NULL ? inFileName : "here-document");
+        fflush(stdout);
+        trackedFree(base);
+        return W_EXITCODE(1, 0);
+    }
+
+    if(outFileName != NULL){
+        outFD = open(outFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(outFD == -1){
+            printf("cannot open %s for output\n", outFileName);
+            fflush(stdout);
+            if(input != stdin)
+                fclose(input);
+            trackedFree(base);
+            return W_EXITCODE(1, 0);
+        }
+    }
+
+    // item text never exceeds the limit, so one pool holds a whole batch:
+    pool = trackedMalloc(limit);
+    argvCapacity = baseCount + 1024;
+    argv = trackedMalloc(argvCapacity * sizeof(char*));
+    memcpy(argv, base, baseCount * sizeof(char*));
+    argvCount = baseCount;
+    used = baseUsed;
+
+    line = trackedMalloc(BATCH_MAX_ITEM + 2);
+
+    while(!stopLaunching){
+        // a NULL line means input is done, flush whatever is packed:
+        bool haveLine = fgets(line, BATCH_MAX_ITEM + 2, input) != NULL;
+
+        if(haveLine){
+            itemLen = strlen(line);
+            wholeLine = itemLen > 0 && line[itemLen - 1] == '\n';
+            if(wholeLine)
+                line[--itemLen] = '\0';
+
+            // item plus its \0 must fit in one kernel arg, else skip it
+            // (and the rest of its line if fgets stopped short):
+            if(itemLen >= BATCH_MAX_ITEM){
+                printf("batch: item longer than %d bytes skipped\n",
+                       BATCH_MAX_ITEM - 1);
                 fflush(stdout);
-                runStatus(childIdStatus); // prints exit status
-                childProcessArray[i] = 0; // remove child pid from array
+                while(!wholeLine &&
+                      fgets(line, BATCH_MAX_ITEM + 2, input) != NULL)
+                    wholeLine = line[strlen(line) - 1] == '\n';
+                continue;
+            }
+
+            if(itemLen == 0)
+                continue;
+
+            // item fits in the current batch:
+            if(used + itemLen + 1 + sizeof(char*) <= (size_t)limit){
+                if(argvCount + 1 >= argvCapacity){
+                    argvCapacity *= 2;
+                    argv = trackedRealloc(argv, argvCapacity * sizeof(char*));
+                }
+                memcpy(pool + poolUsed, line, itemLen + 1);
+                argv[argvCount++] = pool + poolUsed;
+                poolUsed += itemLen + 1;
+                used += itemLen + 1 + sizeof(char*);
+                continue;
+            }
+        }
+
+        // batch is full (or input ended), launch it if it holds any items:
+        if(argvCount > baseCount){
+            // wait for a free slot:
+            while(running >= maxJobs){
+                if(waitpid(-pgid, &spawnStatus, 0) == -1)
+                    break;
+                --running;
+                if(!failed && !(WIFEXITED(spawnStatus) &&
+                                WEXITSTATUS(spawnStatus) == 0)){
+                    batchStatus = spawnStatus;
+                    failed = true;
+                }
+                if(WIFSIGNALED(spawnStatus))
+                    stopLaunching = true;
+                if(running == 0 && !keepTerminal){
+                    pgid = 0;
+                    giveTerminalTo(shellPgid);
+                }
             }
+
+            if(stopLaunching)
+                break;
+
+            argv[argvCount] = NULL;
+            pgid = launchBatch(argv, outFD, pgid);
+            ++running;
+
+            // children have their own copy, so the buffers are reused:
+            argvCount = baseCount;
+            poolUsed = 0;
+            used = baseUsed;
+        }
+
+        if(!haveLine)
+            break;
+
+        // item too large for even an empty batch (huge environment):
+        if(baseUsed + itemLen + 1 + sizeof(char*) > (size_t)limit){
+            printf("batch: item does not fit in argument space, skipped\n");
+            fflush(stdout);
+            continue;
+        }
+
+        // item that did not fit starts the next batch:
+        memcpy(pool, line, itemLen + 1);
+        argv[argvCount++] = pool;
+        poolUsed = itemLen + 1;
+        used += itemLen + 1 + sizeof(char*);
+    }
+
+    // wait for every batch still running:
+    while(running > 0 && waitpid(-pgid, &spawnStatus, 0) != -1){
+        --running;
+        if(!failed && !(WIFEXITED(spawnStatus) &&
+                        WEXITSTATUS(spawnStatus) == 0)){
+            batchStatus = spawnStatus;
+            failed = true;
         }
     }
+    giveTerminalTo(shellPgid);
+
+    if(!failed)
+        batchStatus = spawnStatus;
+
+    // shell keeps reading stdin after the items, e.g. after ^D:
+    if(input == stdin)
+        clearerr(stdin);
+    else
+        fclose(input);
+
+    if(outFD != -1)
+        close(outFD);
+
+    trackedFree(line);
+    trackedFree(argv);
+    trackedFree(pool);
+    trackedFree(base);
+
+    return batchStatus;
+}
+
+/*******************************************************************************
+* Function: batchArgLimit
+* Desc:     returns the number of bytes of args (strings, terminators and argv
+*           pointers) one exec can take: sysconf(_SC_ARG_MAX) less the size of
+*           the environment the child inherits and 2048 bytes of headroom, as
+*           POSIX recommends for xargs.
+*******************************************************************************/
+long batchArgLimit(){
+    extern char** environ;
+    long limit = sysconf(_SC_ARG_MAX);
+
+    // fall back to the POSIX minimum if the limit is unknown:
+    if(limit <= 0)
+        limit = _POSIX_ARG_MAX;
+
+    for(char** env = environ; *env != NULL; ++env)
+        limit -= strlen(*env) + 1 + sizeof(char*);
+
+    // argv's NULL terminator and headroom:
+    limit -= sizeof(char*) + 2048;
+
+    return limit > 0 ? limit : 0;
+}
+
+/*******************************************************************************
+* Function: launchBatch
+* Desc:     function forks a child that runs the NULL terminated argv with stdin
+*           from /dev/null and stdout to outFD (unless -1). the child joins
+*           process group pgid, or leads a new one (which is given the
+*           terminal) when pgid is 0. returns the process group of the batch.
+*******************************************************************************/
+pid_t launchBatch(char** argv, int outFD, pid_t pgid){
+    int nullFD;
+    pid_t spawnId = fork();
+
+    switch(spawnId){
+        case -1:
+            perror("fork() failed!\n");
+            exit(1);
+            break;
+        case 0:
+            setpgid(0, pgid);
+            if(pgid == 0)
+                giveTerminalTo(getpid());
+
+            // same signal setup as a foreground child of runOther:
+            ignoreSIGTSTP();
+            signal(SIGTTOU, SIG_DFL);
+            signal(SIGTTIN, SIG_DFL);
+            signal(SIGINT, SIG_DFL);
+
+            // items may be coming from stdin, so the command gets /dev/null:
+            nullFD = open("/dev/null", O_RDONLY);
+            if(nullFD != -1){
+                dup2(nullFD, 0);
+                close(nullFD);
+            }
+
+            if(outFD != -1 && dup2(outFD, 1) == -1){
+                perror("target dup2()");
+                exit(2);
+            }
+
+            execvp(argv[0], argv);
+
+            // exec error printing (child only returns due to error), with
+            // the real cause since E2BIG and EACCES are possible here too:
+            printf("%s: %s\n", argv[0], strerror(errno));
+            fflush(stdout);
+            exit(1);
+        default:
+            // also set in parent, whichever runs first wins:
+            setpgid(spawnId, pgid == 0 ? spawnId : pgid);
+            if(pgid == 0){
+                pgid = spawnId;
+                giveTerminalTo(pgid);
+            }
+            break;
+    }
+
+    return pgid;
 }
 
 /*******************************************************************************
@@ -687,14 +1851,209 @@ void ignoreSIGTSTP(){
 
 /*******************************************************************************
 * Function: killChildProcesses
-* Desc:     function receives child process id array (ints) and kills each one.
-*           this function is called from runShell upon exiting the shell.
+* Desc:     function receives the job table and shuts every job down. this
+*           function is called from runShell upon exiting the shell. each
+*           process group is sent SIGTERM (stopped jobs are continued so they
+*           can act on it) and given until KILL_DEADLINE_MS to exit. any group
+*           still around after the drain is sent SIGKILL, so exit takes bounded
+*           time no matter how many jobs are running.
+*******************************************************************************/
+void killChildProcesses(struct jobTable* jobTable){
+
+    int childId;
+    int index;
+    int remaining = jobTable->count;   // leaders not yet reaped
+    struct timespec now;
+    struct timespec deadline;
+    struct timespec pause = {0, 10 * 1000000};   // 10ms between reap polls
+
+    // ask each job to terminate:
+    for(int i = 0; i < jobTable->count; ++i){
+        killpg(jobTable->jobs[i].pgid, SIGTERM);
+        if(jobTable->jobs[i].state == jobStopped)
+            killpg(jobTable->jobs[i].pgid, SIGCONT);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += KILL_DEADLINE_MS / 1000;
+    deadline.tv_nsec += (KILL_DEADLINE_MS % 1000) * 1000000;
+    if(deadline.tv_nsec >= 1000000000){
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    // drain: reap leaders as they exit until all are gone or time is up:
+    while(remaining > 0){
+        childId = waitpid(-1, NULL, WNOHANG);
+
+        if(childId > 0){
+            index = findJobIndex(jobTable, childId);
+            if(index != -1 && jobTable->jobs[index].state != jobDone){
+                jobTable->jobs[index].state = jobDone;
+                --remaining;
+            }
+            continue;
+        }
+
+        // no children left at all:
+        if(childId == -1)
+            break;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if(now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec &&
+           now.tv_nsec >= deadline.tv_nsec))
+            break;
+
+        nanosleep(&pause, NULL);
+    }
+
+    // SIGKILL every group, which also catches descendants of leaders that
+    // exited during the drain, then reap the leaders that ignored SIGTERM:
+    for(int i = 0; i < jobTable->count; ++i){
+        killpg(jobTable->jobs[i].pgid, SIGKILL);
+        if(jobTable->jobs[i].state != jobDone)
+            waitpid(jobTable->jobs[i].pgid, NULL, 0);
+        trackedFree(jobTable->jobs[i].cmdLine);
+    }
+
+    trackedFree(jobTable->jobs);
+    trackedFree(jobTable);
+}
+
+/*******************************************************************************
+* Function: trackedMalloc
+* Desc:     counting wrapper around malloc used for all of smallsh's dynamic
+*           memory. a small header in front of each block records its size so
+*           trackedFree can keep the live byte count accurate. returns a
+*           pointer to the usable memory or NULL if malloc fails.
 *******************************************************************************/
-void killChildProcesses(int* childProcArray){
-    for(int i = 0; i < 100; ++i){
-        if(childProcArray[i] != 0)
-            kill(childProcArray[i], SIGKILL);
+void* trackedMalloc(size_t size){
+
+    union allocHeader* header = malloc(sizeof(union allocHeader) + size);
+
+    if(header == NULL)
+        return NULL;
+
+    header->size = size;
+
+    heapStats.liveAllocs++;
+    heapStats.liveBytes += size;
+    heapStats.totalAllocs++;
+
+    // usable memory begins right after the header:
+    return header + 1;
+}
+
+/*******************************************************************************
+* Function: trackedCalloc
+* Desc:     counting wrapper around calloc. receives the number of elements and
+*           the size of each, and returns zeroed memory from trackedMalloc.
+*******************************************************************************/
+void* trackedCalloc(size_t count, size_t size){
+
+    // guard against count * size overflowing:
+    if(size != 0 && count > SIZE_MAX / size)
+        return NULL;
+
+    void* ptr = trackedMalloc(count * size);
+
+    if(ptr != NULL)
+        memset(ptr, 0, count * size);
+
+    return ptr;
+}
+
+/*******************************************************************************
+* Function: trackedRealloc
+* Desc:     counting wrapper around realloc. receives memory from trackedMalloc
+*           (or NULL) and the new size, and returns the resized block. the live
+*           byte count is adjusted by the change in size. on failure NULL is
+*           returned and the original block is left as is.
+*******************************************************************************/
+void* trackedRealloc(void* ptr, size_t size){
+
+    if(ptr == NULL)
+        return trackedMalloc(size);
+
+    union allocHeader* header = (union allocHeader*)ptr - 1;
+    size_t oldSize = header->size;
+
+    header = realloc(header, sizeof(union allocHeader) + size);
+
+    if(header == NULL)
+        return NULL;
+
+    header->size = size;
+    heapStats.liveBytes = heapStats.liveBytes - oldSize + size;
+
+    return header + 1;
+}
+
+/*******************************************************************************
+* Function: trackedFree
+* Desc:     releases memory from trackedMalloc/trackedCalloc and updates the
+*           live counters. like free, a NULL pointer is ignored.
+*******************************************************************************/
+void trackedFree(void* ptr){
+
+    if(ptr == NULL)
+        return;
+
+    // step back to the header written by trackedMalloc:
+    union allocHeader* header = (union allocHeader*)ptr - 1;
+
+    heapStats.liveAllocs--;
+    heapStats.liveBytes -= header->size;
+
+    free(header);
+}
+
+/*******************************************************************************
+* Function: countOpenFDs
+* Desc:     takes a census of the shell's open file descriptors by listing
+*           /proc/self/fd. the descriptor used to read the directory itself is
+*           not counted. returns -1 if /proc is unavailable.
+*******************************************************************************/
+int countOpenFDs(){
+
+    int count = 0;
+    struct dirent* entry;
+    DIR* fdDir = opendir("/proc/self/fd");
+
+    if(fdDir == NULL)
+        return -1;
+
+    while((entry = readdir(fdDir)) != NULL){
+        // skip . and .. entries:
+        if(entry->d_name[0] == '.')
+            continue;
+
+        // skip the fd opendir is holding for this scan:
+        if(atoi(entry->d_name) == dirfd(fdDir))
+            continue;
+
+        ++count;
     }
 
-    free(childProcArray);
+    closedir(fdDir);
+
+    return count;
+}
+
+/*******************************************************************************
+* Function: runMemStats
+* Desc:     this is a built-in function. it prints the allocation counters kept
+*           by trackedMalloc/trackedFree and the number of open file
+*           descriptors so leaks show up as growth across long sessions. it
+*           returns INT_MIN to indicate a built-in command.
+*******************************************************************************/
+int runMemStats(){
+
+    printf("heap: %zu live allocations (%zu bytes), %zu allocations total\n",
+           heapStats.liveAllocs, heapStats.liveBytes, heapStats.totalAllocs);
+    printf("fds: %d open\n", countOpenFDs());
+    fflush(stdout);
+
+    // memstats is built-in function so return INT_MIN as indicator to status:
+    return INT_MIN;
 }
@@ -5,13 +5,22 @@
 *         contains the function prototypes for the functions used for the
 *         shell.
 *******************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // memfd_create
+#endif
+
+#include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>      
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <sys/mman.h>   // memfd_create
 #include <sys/types.h>  // pid_t, not used in this example
 #include <sys/wait.h>
 #include <unistd.h>     // getpid, getppid
@@ -19,9 +28,54 @@
 #ifndef SMALL_SHELL_H
 #define SMALL_SHELL_H
 
+// list operator placed before a command on the same line:
+enum connector {connectNone, connectSequence, connectAnd, connectOr};
+
 struct command {
     char* pathname;
     char** args;
+    bool hasHereDoc;     // <<WORD or <<< was given, even with empty text
+    char* hereDoc;       // stdin text from <<WORD or <<<, NULL if empty
+    size_t hereDocLen;
+    enum connector connector;  // how this command joins the one before it
+    struct command* next;      // next command on the line, NULL if last
+};
+
+// linux MAX_ARG_STRLEN: bytes allowed in one arg including its \0, so the
+// longest item batch will pass is BATCH_MAX_ITEM - 1:
+#define BATCH_MAX_ITEM 131072
+
+// how long exit waits for jobs to honour SIGTERM before sending SIGKILL:
+#define KILL_DEADLINE_MS 2000
+
+// states a job can be in while held in the job table:
+enum jobState {jobRunning, jobStopped, jobDone};
+
+struct job {
+    int id;              // job number used by jobs, fg %n and bg %n
+    pid_t pgid;          // process group of the job (same as leader pid)
+    char* cmdLine;       // command text shown by jobs
+    enum jobState state;
+};
+
+// background and stopped jobs, in launch order:
+struct jobTable {
+    struct job* jobs;
+    int count;
+    int capacity;
+};
+
+// allocation counters maintained by the tracked allocator:
+struct memStats {
+    size_t liveAllocs;   // blocks currently allocated
+    size_t liveBytes;    // bytes currently allocated (excluding headers)
+    size_t totalAllocs;  // blocks allocated since startup
+};
+
+// header stored in front of each tracked block, padded for alignment:
+union allocHeader {
+    size_t size;
+    long double align;
 };
 
 void runShell();
@@ -32,6 +86,19 @@ struct command* prompt();
 // char** parseString(char*,char*);
 void parseString(char*, char*, struct command*);
 
+// copy of a line with ;, && and || set apart by the separator:
+char* separateOperators(char*, char);
+
+void initCommand(struct command*, enum connector);
+
+enum connector checkConnector(char*);
+
+// false (after printing a syntax error) if an operator lacks a command:
+bool checkCommandList(struct command*);
+
+// true if a command should run given the last status and its connector:
+bool shouldRunCommand(struct command*, int);
+
 struct command* buildCommandStruct(char**);
 
 void runNonBuiltIn(int argc, char* args[]);
@@ -39,6 +106,9 @@ void runNonBuiltIn(int argc, char* args[]);
 // void freeMemArray(char**); // free array of strings
 void freeMem(struct command*);
 
+// frees every command in a list:
+void freeCommandList(struct command*);
+
 int checkCommand(char*); // check command type
 
 void removeNewLine(char*); // removes '\n' character from string passed
@@ -53,7 +123,7 @@ int runCd(struct command*);
 int runStatus(int);      
 
 // int runOther(char**, int*); // runs nonbuilt-in commands, returns status
-int runOther(struct command*, int*);
+int runOther(struct command*, struct jobTable*);
 
 // expands any instance of $$ into the smallsh process id:
 char* expandAny$$(char*);
@@ -62,15 +132,66 @@ char* expandAny$$(char*);
 // bool redirNeeded(char**, int*);
 bool redirNeeded(struct command*, int*, bool);
 
+// drops < and > operators and their filenames from args:
+void removeRedirArgs(char**);
+
+// reads here-document bodies and here-strings into the command struct
+// returns false on a syntax error
+bool collectHereDoc(struct command*);
+
+// appends text to a here-document body being built:
+void appendHereDoc(struct command*, char*, size_t, size_t*);
+
+// returns readable fd holding the here-document body, -1 on error:
+int openHereDoc(struct command*);
+
+// closes the INT_MIN terminated fd array built by redirNeeded:
+void closeFDArray(int*);
+
 bool isBackgroundProcess(char**);
 
-void initProcArray(int*);
+void initJobTable(struct jobTable*);
 
 void initArgArray(struct command*);
 
-void addChildProcess(int*, int);
+struct job* addJob(struct jobTable*, pid_t, char*, enum jobState);
+
+void removeJob(struct jobTable*, int);
+
+int findJobIndex(struct jobTable*, pid_t);
+
+void checkChildProcesses(struct jobTable*);
+
+// records terminal state and ignores SIGTTOU/SIGTTIN when interactive:
+void initJobControl();
+
+void giveTerminalTo(pid_t);
 
-void checkChildProcesses(int*);
+// waits on a foreground process group, returns its wait status:
+int waitForeground(pid_t);
+
+char* buildCommandLine(char**);
+
+// returns job table index for fg/bg argument or -1:
+int findJobSpec(struct jobTable*, char*, char*);
+
+// returns INT_MIN to indicate built-in command
+int runJobs(struct jobTable*);
+
+// returns wait status of the resumed job
+int runFg(struct command*, struct jobTable*);
+
+// returns INT_MIN to indicate built-in command
+int runBg(struct command*, struct jobTable*);
+
+// xargs-style builtin, returns wait status of the batches
+int runBatch(struct command*);
+
+// bytes of args one exec can take after the environment:
+long batchArgLimit();
+
+// forks one batch into process group (0 for new), returns the group:
+pid_t launchBatch(char**, int, pid_t);
 
 void ignoreSIGINT();
 
@@ -80,6 +201,22 @@ void ignoreSIGTSTP();
 
 void installSIGTSTP();
 
-void killChildProcesses(int*);
+void killChildProcesses(struct jobTable*);
+
+// counting allocator wrappers used in place of malloc/calloc/free:
+void* trackedMalloc(size_t);
+
+void* trackedCalloc(size_t, size_t);
+
+void* trackedRealloc(void*, size_t);
+
+void trackedFree(void*);
+
+// number of open fds from /proc/self/fd, -1 if unavailable:
+int countOpenFDs();
+
+// prints heap and fd counters
+// returns INT_MIN to indicate built-in command
+int runMemStats();
 
 #endif 
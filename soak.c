@@ -0,0 +1,222 @@
+/*******************************************************************************
+* Date:   10-19-2026
+* Desc:   This is the soak test program for smallsh. It drives the smallsh
+*         binary over pipes with a repeating mix of redirections, background
+*         jobs, here-documents, batch, command lists, and built-ins, and runs
+*         memstats at regular checkpoints. It fails if the heap allocation
+*         count, live heap bytes, or open fd count at any checkpoint is above
+*         the baseline taken after the first cycle.
+*
+*         usage: smallshSoak [path to smallsh] [commands to run]
+*******************************************************************************/
+#include "shellDriver.h"
+#include <poll.h>
+
+#define SOAK_DEFAULT_COMMANDS 2000000   // commands run when none are given
+#define SOAK_CHECK_EVERY 1000           // cycles between memstats checkpoints
+
+// one cycle of input, SOAK_CYCLE_COMMANDS commands (comments and blank lines
+// are not counted). $$ keeps the scratch file unique to the shell under test:
+#define SOAK_CYCLE \
+    "echo soak $$ > /tmp/smallshSoak.$$\n" \
+    "cat < /tmp/smallshSoak.$$ > /dev/null\n" \
+    "true &\n" \
+    "cd /tmp ; cd / ; status ; jobs ; cd /tmp\n" \
+    "fg %999 ; bg 999 ; cd /nonexistent ; cd /tmp\n" \
+    "# comment line\n" \
+    "\n" \
+    "status && jobs || status\n" \
+    "nosuchcmd <<< x || status\n" \
+    "cat > /dev/null << EOF\nline $$\nEOF\n" \
+    "batch -a /tmp/smallshSoak.$$ true\n" \
+    "status ; jobs ; cd /tmp ; status ; jobs ; cd /tmp ; status ; jobs ; " \
+    "cd /tmp ; status ; jobs ; cd /tmp ; status ; jobs ; cd /tmp ; status ; " \
+    "jobs ; cd /tmp ; status ; jobs ; cd /tmp ; status ; jobs ; cd /tmp ; " \
+    "status ; jobs ; cd /tmp ; status ; jobs ; cd /tmp\n"
+#define SOAK_CYCLE_COMMANDS 49
+
+// lets background jobs finish and be reaped, then takes a checkpoint:
+#define SOAK_CHECKPOINT "sleep 0.1\nmemstats\n"
+
+// counters parsed from memstats output:
+struct checkpoint {
+    size_t liveAllocs;
+    size_t liveBytes;
+    int openFDs;
+};
+
+struct soakState {
+    char line[4096];           // partial output line being assembled
+    size_t lineLen;
+    struct checkpoint current; // heap line waits for its fds line
+    struct checkpoint baseline;
+    struct checkpoint worst;   // largest values seen after the baseline
+    int checkpoints;           // complete memstats outputs seen
+    bool grew;                 // a checkpoint exceeded the baseline
+};
+
+/*******************************************************************************
+* Function: processLine
+* Desc:     receives one line of shell output and records memstats counters.
+*           the first complete checkpoint becomes the baseline, and later ones
+*           are compared against it.
+*******************************************************************************/
+void processLine(struct soakState* state, char* line){
+
+    char* found;
+    struct checkpoint* cp = &state->current;
+
+    if((found = strstr(line, "heap: ")) != NULL){
+        sscanf(found, "heap: %zu live allocations (%zu bytes)",
+               &cp->liveAllocs, &cp->liveBytes);
+        return;
+    }
+
+    if((found = strstr(line, "fds: ")) == NULL)
+        return;
+
+    sscanf(found, "fds: %d open", &cp->openFDs);
+
+    if(state->checkpoints++ == 0){
+        state->baseline = *cp;
+        state->worst = *cp;
+        return;
+    }
+
+    if(cp->liveAllocs > state->worst.liveAllocs)
+        state->worst.liveAllocs = cp->liveAllocs;
+    if(cp->liveBytes > state->worst.liveBytes)
+        state->worst.liveBytes = cp->liveBytes;
+    if(cp->openFDs > state->worst.openFDs)
+        state->worst.openFDs = cp->openFDs;
+
+    if(cp->liveAllocs > state->baseline.liveAllocs ||
+       cp->liveBytes > state->baseline.liveBytes ||
+       cp->openFDs > state->baseline.openFDs || cp->openFDs < 0)
+        state->grew = true;
+}
+
+/*******************************************************************************
+* Function: drainOutput
+* Desc:     reads whatever output the shell has ready and passes each complete
+*           line to processLine. returns false once the shell closes stdout.
+*******************************************************************************/
+bool drainOutput(struct shell* sh, struct soakState* state){
+
+    char buffer[4096];
+    ssize_t got = read(sh->fromShell, buffer, sizeof(buffer));
+
+    if(got <= 0)
+        return false;
+
+    for(ssize_t i = 0; i < got; ++i){
+        if(buffer[i] == '\n' || state->lineLen == sizeof(state->line) - 1){
+            state->line[state->lineLen] = '\0';
+            processLine(state, state->line);
+            state->lineLen = 0;
+        }
+        else
+            state->line[state->lineLen++] = buffer[i];
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function: sendText
+* Desc:     writes text to the shell's stdin, draining its output whenever it
+*           is ready so neither side blocks on a full pipe.
+*******************************************************************************/
+void sendText(struct shell* sh, struct soakState* state, char* text){
+
+    size_t len = strlen(text);
+    ssize_t written;
+    struct pollfd fds[2] = {{sh->toShell, POLLOUT, 0},
+                            {sh->fromShell, POLLIN, 0}};
+
+    while(len > 0){
+        if(poll(fds, 2, -1) == -1){
+            perror("poll()");
+            exit(1);
+        }
+
+        if(fds[1].revents & (POLLIN | POLLHUP)){
+            if(!drainOutput(sh, state)){
+                fprintf(stderr, "soak: smallsh exited early\n");
+                exit(1);
+            }
+        }
+
+        if(fds[0].revents & POLLOUT){
+            written = write(sh->toShell, text, len);
+            if(written > 0){
+                text += written;
+                len -= written;
+            }
+        }
+        else if(fds[0].revents & (POLLERR | POLLHUP)){
+            fprintf(stderr, "soak: smallsh stopped reading input\n");
+            exit(1);
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+
+    char* path = argc > 1 ? argv[1] : "./smallsh";
+    long commands = argc > 2 ? atol(argv[2]) : SOAK_DEFAULT_COMMANDS;
+    long cycles = (commands + SOAK_CYCLE_COMMANDS - 1) / SOAK_CYCLE_COMMANDS;
+    int expected = 1;   // checkpoints sent, starting with the baseline
+    struct soakState state;
+    struct shell sh;
+
+    memset(&state, 0, sizeof(state));
+
+    // keep a closed pipe from killing the harness if the shell dies:
+    signal(SIGPIPE, SIG_IGN);
+
+    sh = startShell(path, true);
+
+    // baseline is taken after one cycle so lazily grown tables exist:
+    sendText(&sh, &state, SOAK_CYCLE SOAK_CHECKPOINT);
+
+    for(long c = 1; c < cycles; ++c){
+        sendText(&sh, &state, SOAK_CYCLE);
+        if(c % SOAK_CHECK_EVERY == 0){
+            sendText(&sh, &state, SOAK_CHECKPOINT);
+            ++expected;
+        }
+    }
+
+    sendText(&sh, &state, SOAK_CHECKPOINT "rm -f /tmp/smallshSoak.$$\nexit\n");
+    ++expected;
+    close(sh.toShell);
+
+    while(drainOutput(&sh, &state))
+        ;
+    close(sh.fromShell);
+    waitpid(sh.pid, NULL, 0);
+
+    printf("soak: %ld commands, %d checkpoints\n",
+           cycles * SOAK_CYCLE_COMMANDS, state.checkpoints);
+    printf("baseline: %zu allocations (%zu bytes), %d fds\n",
+           state.baseline.liveAllocs, state.baseline.liveBytes,
+           state.baseline.openFDs);
+    printf("worst:    %zu allocations (%zu bytes), %d fds\n",
+           state.worst.liveAllocs, state.worst.liveBytes,
+           state.worst.openFDs);
+
+    if(state.checkpoints != expected){
+        printf("FAIL: expected %d checkpoints\n", expected);
+        return EXIT_FAILURE;
+    }
+
+    if(state.grew){
+        printf("FAIL: memory or fd count grew\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("PASS\n");
+
+    return EXIT_SUCCESS;
+}